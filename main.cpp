@@ -8,9 +8,11 @@
 #include <GL/glut.h>
 #include <stdio.h>
 #include <math.h>
+#include <assert.h>
 #include <windows.h>
 #include <fstream>
 #include <mmsystem.h>
+#include <algorithm>
 
 // Body Definitions
 #define BODY_WIDTH 2
@@ -18,6 +20,10 @@
 #define BODY_DEPTH 1
 #define PI 3.141592
 
+// Render Queue Definitions
+#define FRAME_ARENA_SIZE 16384 // Bytes of packet storage available to a single frame
+#define MATRIX_STACK_DEPTH 8   // Nesting depth of the recording matrix stack
+
 // Global Variables
 char title[] = "POLISH ROBOT"; // Window border name
 
@@ -42,6 +48,7 @@ bool baxis = true;
 bool path = false;
 bool walking = false;
 bool music = true;
+bool wireframe = false;
 
 static int u = 0;                 // curve parameter for comet pos
 
@@ -54,27 +61,185 @@ int mouseX = 0, mouseY = 0; //last known X and Y of the mouse
 float cameraTheta, cameraPhi, cameraRadius; //camera position in spherical coordinates
 float x, y, z; //camera position in cartesian coordinates
 
-// solidBox(w, h, d) makes a box with width w, height h and
-// depth d centered at the origin. It uses the GLUT solid cube function.
-// The calls to glPushMatrix and glPopMatrix are essential here; they enable
-// this function to be called from just about anywhere and guarantee that
-// the glScalef call does not pollute code that follows a call to mySolidBox.
+// Render queue. Instead of issuing GL calls in source order, the ground, path,
+// axes and robot parts record a DrawPacket per draw into a per-frame arena.
+// Transforms are tracked on a CPU-side matrix stack, so recording never talks
+// to GL. At the end of the frame the packets are sorted by key (pipeline, mesh,
+// material) and submitted, only touching GL state when it actually changes.
+enum renderPipeline {pipelineSolid, pipelineWireframe, pipelineLines};
+enum renderMesh {meshCube, meshSphere, meshTorus, meshAxes};
+enum renderMaterial {materialWhite, materialGround, materialStraightPath, materialCircularPath, materialVertexColor};
+
+static const GLfloat materialColors[][3] = {
+	{1.0, 1.0, 1.0}, // materialWhite
+	{0.9, 0.7, 0.9}, // materialGround
+	{0.7, 0.6, 0.5}, // materialStraightPath
+	{0.3, 0.4, 0.5}, // materialCircularPath
+};
+
+struct DrawPacket {
+	unsigned int key;        // (pipeline << 16) | (mesh << 8) | material
+	unsigned int sequence;   // record order, used to break ties in the sort
+	GLfloat modelview[16];   // modelview at record time with the box/sphere scale baked in
+};
+
+// Per-frame counters, refreshed every time a frame is submitted
+struct RenderStats {
+	unsigned int packets;      // packets recorded this frame
+	unsigned int draws;        // mesh draws submitted this frame
+	unsigned int stateChanges; // glPolygonMode / glColor3f calls actually issued
+	unsigned int droppedPackets; // draws lost because the arena was exhausted
+	size_t arenaBytes;         // arena bytes used this frame
+};
+
+RenderStats frameStats;
+
+// The arena is a static block that is reset at the start of every frame, so
+// recording and sorting never touch the heap. Packets are bump allocated back
+// to back, which lets them be walked as a plain array from the first one.
+static union {
+	double align;
+	unsigned char bytes[FRAME_ARENA_SIZE];
+} frameArena;
+static size_t frameArenaUsed = 0;
+
+static DrawPacket* framePackets = NULL;
+
+// Display lists holding the geometry of each renderMesh, built once in init()
+static GLuint meshLists[meshAxes + 1];
+
+// GL state last sent by submitFrame(); it persists between frames
+static GLenum boundPolygonMode = 0;
+static int boundMaterial = -1;
+
+// Column-major modelview stack used while recording, mirroring the GL matrix calls
+static GLfloat matrixStack[MATRIX_STACK_DEPTH][16];
+static int matrixTop = 0;
+
+// Bump allocates from the frame arena, returning NULL once it is exhausted
+void* arenaAlloc(size_t size) {
+	size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+	if (frameArenaUsed + size > FRAME_ARENA_SIZE)    return NULL;
+	void* block = frameArena.bytes + frameArenaUsed;
+	frameArenaUsed += size;
+	return block;
+}
+
+// Releases everything recorded for the previous frame
+void beginFrame() {
+	frameArenaUsed = 0;
+	framePackets = NULL;
+	frameStats.packets = 0;
+	frameStats.draws = 0;
+	frameStats.stateChanges = 0;
+	frameStats.droppedPackets = 0;
+	frameStats.arenaBytes = 0;
+}
+
+// Seeds the recording matrix stack with the camera, computed the same way gluLookAt does
+void recordLookAt(GLfloat eyeX, GLfloat eyeY, GLfloat eyeZ, GLfloat centerX, GLfloat centerY, GLfloat centerZ, GLfloat upX, GLfloat upY, GLfloat upZ) {
+	GLfloat f[3] = {centerX - eyeX, centerY - eyeY, centerZ - eyeZ};
+	GLfloat length = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	f[0] /= length; f[1] /= length; f[2] /= length;
+
+	// side = forward x up, then recompute up = side x forward so the basis is orthonormal
+	GLfloat s[3] = {f[1] * upZ - f[2] * upY, f[2] * upX - f[0] * upZ, f[0] * upY - f[1] * upX};
+	length = sqrtf(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+	s[0] /= length; s[1] /= length; s[2] /= length;
+	GLfloat v[3] = {s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0]};
+
+	GLfloat* m = matrixStack[0];
+	matrixTop = 0;
+	m[0] = s[0]; m[4] = s[1]; m[8] = s[2];
+	m[1] = v[0]; m[5] = v[1]; m[9] = v[2];
+	m[2] = -f[0]; m[6] = -f[1]; m[10] = -f[2];
+	m[3] = m[7] = m[11] = 0;
+	m[12] = -(s[0] * eyeX + s[1] * eyeY + s[2] * eyeZ);
+	m[13] = -(v[0] * eyeX + v[1] * eyeY + v[2] * eyeZ);
+	m[14] = f[0] * eyeX + f[1] * eyeY + f[2] * eyeZ;
+	m[15] = 1;
+}
+
+void recordPushMatrix() {
+	assert(matrixTop + 1 < MATRIX_STACK_DEPTH);
+	for (int i = 0; i < 16; i++)    matrixStack[matrixTop + 1][i] = matrixStack[matrixTop][i];
+	matrixTop++;
+}
+
+void recordPopMatrix() {
+	assert(matrixTop > 0);
+	matrixTop--;
+}
+
+// Same as glTranslatef, applied to the top of the recording stack
+void recordTranslatef(GLfloat tx, GLfloat ty, GLfloat tz) {
+	GLfloat* m = matrixStack[matrixTop];
+	for (int i = 0; i < 4; i++)    m[12 + i] += m[i] * tx + m[4 + i] * ty + m[8 + i] * tz;
+}
+
+// Same as glRotatef (angle in degrees about the axis (ax, ay, az)), applied to the top of the recording stack
+void recordRotatef(GLfloat degrees, GLfloat ax, GLfloat ay, GLfloat az) {
+	GLfloat length = sqrtf(ax * ax + ay * ay + az * az);
+	ax /= length; ay /= length; az /= length;
+	GLfloat c = cosf(degrees * (GLfloat)PI / 180), sn = sinf(degrees * (GLfloat)PI / 180), t = 1 - c;
+
+	// Columns of the rotation matrix
+	GLfloat r[3][3] = {
+		{t * ax * ax + c, t * ax * ay + sn * az, t * ax * az - sn * ay},
+		{t * ax * ay - sn * az, t * ay * ay + c, t * ay * az + sn * ax},
+		{t * ax * az + sn * ay, t * ay * az - sn * ax, t * az * az + c},
+	};
+
+	GLfloat* m = matrixStack[matrixTop];
+	GLfloat result[12];
+	for (int col = 0; col < 3; col++)
+		for (int i = 0; i < 4; i++)
+			result[col * 4 + i] = m[i] * r[col][0] + m[4 + i] * r[col][1] + m[8 + i] * r[col][2];
+	for (int i = 0; i < 12; i++)    m[i] = result[i];
+}
+
+// Records a draw of mesh with the given material using the current recording
+// matrix scaled by (width, height, depth). If the arena is full the draw is
+// dropped and counted in frameStats.droppedPackets.
+void recordDraw(renderMesh mesh, renderMaterial material, GLfloat width, GLfloat height, GLfloat depth) {
+	DrawPacket* packet = (DrawPacket*)arenaAlloc(sizeof(DrawPacket));
+	if (packet == NULL) {
+		frameStats.droppedPackets++;
+		assert(!"frame arena exhausted, draw dropped");
+		return;
+	}
+	// Packets must stay contiguous so submitFrame() can index them as an array
+	assert(framePackets == NULL || packet == framePackets + frameStats.packets);
+	if (framePackets == NULL)    framePackets = packet;
+
+	for (int i = 0; i < 16; i++)    packet->modelview[i] = matrixStack[matrixTop][i];
+	for (int i = 0; i < 4; i++) {
+		packet->modelview[i] *= width;
+		packet->modelview[4 + i] *= height;
+		packet->modelview[8 + i] *= depth;
+	}
+
+	renderPipeline pipeline = pipelineSolid;
+	if (mesh == meshAxes)    pipeline = pipelineLines;
+	else if (wireframe)    pipeline = pipelineWireframe;
+
+	packet->key = (pipeline << 16) | (mesh << 8) | material;
+	packet->sequence = frameStats.packets++;
+}
+
+// solidBox(w, h, d) records a box with width w, height h and
+// depth d centered at the origin. It is drawn with the GLUT solid cube function
+// when the frame is submitted. The scale is baked into the recorded packet
+// rather than applied to the recording stack, so it cannot pollute code that
+// follows a call to solidBox.
 // (Note: Function based on original wireBox function) 
 void solidBox(GLdouble width, GLdouble height, GLdouble depth) {
-	glPushMatrix();
-	glColor3f(1, 1, 1);
-	glScalef(width, height, depth);
-	glutSolidCube(1.0);
-	glPopMatrix();
+	recordDraw(meshCube, materialWhite, width, height, depth);
 }
 
-// Same as solidBox, but with a color option
-void solidBoxColor(GLdouble width, GLdouble height, GLdouble depth, GLdouble red, GLdouble green, GLdouble blue) {
-	glPushMatrix();
-	glColor3f(red, green, blue);
-	glScalef(width, height, depth);
-	glutSolidCube(1.0);
-	glPopMatrix();
+// Same as solidBox, but with a material option
+void solidBoxMaterial(GLdouble width, GLdouble height, GLdouble depth, renderMaterial material) {
+	recordDraw(meshCube, material, width, height, depth);
 }
 
 // Plays music using Window's PlaySound() function
@@ -101,18 +266,12 @@ void resetPosition() {
 	playSomeMusic();
 }
 
-// solidSphere(w, h, d) makes a sphere with width w, height h and
-// depth d centered at the origin. It uses the GLUT solid sphere function.
-// The calls to glPushMatrix and glPopMatrix are essential here; they enable
-// this function to be called from just about anywhere and guarantee that
-// the glScalef call does not pollute code that follows a call to mySolidSphere.
+// solidSphere(w, h, d) records a sphere with width w, height h and
+// depth d centered at the origin. It is drawn with the GLUT solid sphere
+// function when the frame is submitted.
 // (Note: Function based on original wireSphere function) 
 void solidSphere(GLdouble width, GLdouble height, GLdouble depth) {
-	glPushMatrix();
-	glColor3f(1, 1, 1);
-	glScalef(width, height, depth);
-	glutSolidSphere(1.0, 50.0, 50.0);
-	glPopMatrix();
+	recordDraw(meshSphere, materialWhite, width, height, depth);
 }
 
 void drawAxes()
@@ -125,19 +284,69 @@ void drawAxes()
 	glEnd();
 }
 
+// Issues the GL calls for a single packet, skipping polygon mode and color
+// changes that match what is already bound.
+void submitPacket(const DrawPacket* packet) {
+	int pipeline = (packet->key >> 16) & 0xff;
+	int mesh = (packet->key >> 8) & 0xff;
+	int material = packet->key & 0xff;
+
+	// Polygon mode has no effect on line primitives, so the lines pipeline leaves it alone
+	if (pipeline != pipelineLines) {
+		GLenum polygonMode = (pipeline == pipelineWireframe) ? GL_LINE : GL_FILL;
+		if (polygonMode != boundPolygonMode) {
+			glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
+			boundPolygonMode = polygonMode;
+			frameStats.stateChanges++;
+		}
+	}
+	if (material != materialVertexColor && material != boundMaterial) {
+		glColor3fv(materialColors[material]);
+		boundMaterial = material;
+		frameStats.stateChanges++;
+	}
+
+	glLoadMatrixf(packet->modelview);
+	glCallList(meshLists[mesh]);
+	if (mesh == meshAxes)    boundMaterial = materialVertexColor; // axes leave the current color undefined
+	frameStats.draws++;
+}
+
+bool packetLess(const DrawPacket* a, const DrawPacket* b) {
+	if (a->key != b->key)    return a->key < b->key;
+	return a->sequence < b->sequence;
+}
+
+// Sorts the packets recorded this frame by key and submits them. The sort
+// index comes out of the frame arena as well; should it not fit, the packets
+// are submitted unsorted in record order.
+void submitFrame() {
+	unsigned int count = frameStats.packets;
+	DrawPacket** order = (DrawPacket**)arenaAlloc(count * sizeof(DrawPacket*));
+	if (order != NULL) {
+		for (unsigned int i = 0; i < count; i++)    order[i] = &framePackets[i];
+		std::sort(order, order + count, packetLess);
+		for (unsigned int i = 0; i < count; i++)    submitPacket(order[i]);
+	}
+	else {
+		for (unsigned int i = 0; i < count; i++)    submitPacket(&framePackets[i]);
+	}
+	frameStats.arenaBytes = frameArenaUsed;
+}
+
 void drawScene()
 {
 	// Body
-	glPushMatrix();
+	recordPushMatrix();
 
 	// Draw the upper body at the orgin
 	solidBox(BODY_WIDTH, BODY_HEIGHT, BODY_DEPTH);
 
-	glPopMatrix();
+	recordPopMatrix();
 
 
 	// Left Arm
-	glPushMatrix();
+	recordPushMatrix();
 
 	// Left Shoulder
 		// Draw the upper arm, rotated shoulder degrees about the z-axis. Note that
@@ -145,10 +354,10 @@ void drawScene()
 		// of the box, but we want the "origin" of our box to be at the left end of
 		// the box, so it needs to first be shifted 1 unit in the x direction, then
 		// rotated.
-	glTranslatef(1.0, 1.5, 0.0); // (4) move to the right end of the upper body (attachment)
-	glRotatef(-90, 0.0, 0.0, 1.0);
-	glRotatef((GLfloat)leftShoulderAngle, 0.0, 1.0, 0.0); //(3) then rotate shoulder
-	glTranslatef(1.0, 0.0, 0.0); // (2) shift to the right on the x axis to have the left end at the origin
+	recordTranslatef(1.0, 1.5, 0.0); // (4) move to the right end of the upper body (attachment)
+	recordRotatef(-90, 0.0, 0.0, 1.0);
+	recordRotatef((GLfloat)leftShoulderAngle, 0.0, 1.0, 0.0); //(3) then rotate shoulder
+	recordTranslatef(1.0, 0.0, 0.0); // (2) shift to the right on the x axis to have the left end at the origin
 	solidBox(2.0, 0.4, 1.0); // (1) draw the upper arm box
 
 	// Left Elbow
@@ -160,128 +369,128 @@ void drawScene()
 		// we translate <1,0,0> before rotating. But after rotating we have to
 		// position the lower arm at the end of the upper arm, so we have to
 		// translate it <1,0,0> again.
-	glTranslatef(1.0, 0.0, 0.0); // (4) move to the right end of the upper arm
-	glRotatef((GLfloat)leftElbowAngle, 0.0, 0.0, 1.0); // (3) rotate
-	glTranslatef(1.0, 0.0, 0.0); // (2) shift to the right on the x axis to have the left end at the origin
+	recordTranslatef(1.0, 0.0, 0.0); // (4) move to the right end of the upper arm
+	recordRotatef((GLfloat)leftElbowAngle, 0.0, 0.0, 1.0); // (3) rotate
+	recordTranslatef(1.0, 0.0, 0.0); // (2) shift to the right on the x axis to have the left end at the origin
 	solidBox(2.0, 0.4, 1.0); // (1) draw the lower arm .
 
-	glPopMatrix();
+	recordPopMatrix();
 
 
 	// Right Arm
-	glPushMatrix();
+	recordPushMatrix();
 
 	// Right Shoulder
-	glTranslatef(-1.0, 1.5, 0.0);
-	glRotatef(180, 0.0, 1.0, 0.0);
-	glRotatef(-90, 0.0, 0.0, 1.0);
-	glRotatef((GLfloat)rightShoulderAngle, 0.0, 1.0, 0.0);
-	glTranslatef(1.0, 0.0, 0.0);
+	recordTranslatef(-1.0, 1.5, 0.0);
+	recordRotatef(180, 0.0, 1.0, 0.0);
+	recordRotatef(-90, 0.0, 0.0, 1.0);
+	recordRotatef((GLfloat)rightShoulderAngle, 0.0, 1.0, 0.0);
+	recordTranslatef(1.0, 0.0, 0.0);
 	solidBox(2.0, 0.4, 1.0);
 
 	// Right Elbow
-	glTranslatef(1.0, 0.0, 0.0);
-	glRotatef((GLfloat)rightElbowAngle, 0.0, 0.0, 1.0);
-	glTranslatef(1.0, 0.0, 0.0);
+	recordTranslatef(1.0, 0.0, 0.0);
+	recordRotatef((GLfloat)rightElbowAngle, 0.0, 0.0, 1.0);
+	recordTranslatef(1.0, 0.0, 0.0);
 	solidBox(2.0, 0.4, 1.0);
 
-	glPopMatrix();
+	recordPopMatrix();
 
 
 	// Left Leg
-	glPushMatrix();
+	recordPushMatrix();
 
 	// Upper Left Leg
-	glTranslatef(0.8, -2.0, 0.0);
-	glRotatef((GLfloat)leftUpperLegAngle, 1.0, 0.0, 0.0);
-	glTranslatef(0.0, -1.0, 0.0);
+	recordTranslatef(0.8, -2.0, 0.0);
+	recordRotatef((GLfloat)leftUpperLegAngle, 1.0, 0.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
 	solidBox(0.4, 2.0, 1.0);
 
 	//Lower Left Leg
-	glTranslatef(0.0, -1.0, 0.0);
-	glRotatef((GLfloat)leftLowerLegAngle, 1.0, 0.0, 0.0);
-	glTranslatef(0.0, -1.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
+	recordRotatef((GLfloat)leftLowerLegAngle, 1.0, 0.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
 	solidBox(0.4, 2.0, 1.0);
 
-	glPopMatrix();
+	recordPopMatrix();
 
 
 	// Right Leg
-	glPushMatrix();
+	recordPushMatrix();
 
 	// Upper Right Leg
-	glTranslatef(-0.8, -2.0, 0.0);
-	glRotatef(180, 1.0, 0.0, 0.0);
-	glRotatef(180, 0.0, 0.0, 1.0);
-	glRotatef((GLfloat)rightUpperLegAngle, 1.0, 0.0, 0.0);
-	glTranslatef(0.0, -1.0, 0.0);
+	recordTranslatef(-0.8, -2.0, 0.0);
+	recordRotatef(180, 1.0, 0.0, 0.0);
+	recordRotatef(180, 0.0, 0.0, 1.0);
+	recordRotatef((GLfloat)rightUpperLegAngle, 1.0, 0.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
 	solidBox(0.4, 2.0, 1.0);
 
 	//Lower Right Leg
-	glTranslatef(0.0, -1.0, 0.0);
-	glRotatef((GLfloat)rightLowerLegAngle, 1.0, 0.0, 0.0);
-	glTranslatef(0.0, -1.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
+	recordRotatef((GLfloat)rightLowerLegAngle, 1.0, 0.0, 0.0);
+	recordTranslatef(0.0, -1.0, 0.0);
 	solidBox(0.4, 2.0, 1.0);
 
-	glPopMatrix();
+	recordPopMatrix();
 
 
 	// Head
-	glPushMatrix();
+	recordPushMatrix();
 
-	glTranslatef(0.0, 3.0, 0.0);
+	recordTranslatef(0.0, 3.0, 0.0);
 	solidSphere(1.0, 1.0, 1.0);
 
-	glPopMatrix();
+	recordPopMatrix();
 }
 
 // Displays the arm in its current position and orientation. The whole
-// function is bracketed by glPushMatrix and glPopMatrix calls because every
-// time we call it we are in an "environment" in which a gluLookAt is in
-// effect. (Note that in particular, replacing glPushMatrix with
-// glLoadIdentity makes you lose the camera setting from gluLookAt).
+// function is bracketed by recordPushMatrix and recordPopMatrix calls because
+// every time we call it we are in an "environment" in which the recordLookAt
+// camera is in effect. (Note that in particular, reseeding the recording stack
+// instead of pushing makes you lose the camera setting from recordLookAt).
 void display() {
 	glMatrixMode(GL_MODELVIEW); //make sure we aren't changing the projection matrix!
-	glLoadIdentity();
-	gluLookAt(x, y, z, //camera is located at (x,y,z)
+	recordLookAt(x, y, z, //camera is located at (x,y,z)
 		0, 0, 0, //camera is looking at (0,0,0)
 		0.0f, 1.0f, 0.0f); //up vector is (0,1,0) (positive Y)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	beginFrame();
 
 	// Draw the ground (a plane)
-	glPushMatrix();
+	recordPushMatrix();
 
-	glTranslatef(0, -6.1, 0);
-	solidBoxColor(1000.0, 0, 1000.0, 0.9, 0.7, 0.9);
+	recordTranslatef(0, -6.1, 0);
+	solidBoxMaterial(1000.0, 0, 1000.0, materialGround);
 
-	glPopMatrix();
+	recordPopMatrix();
 
 	// Draw Path
-	glPushMatrix();
+	recordPushMatrix();
 
 	if (currentPattern == circular && path) {
-		glRotatef(90, 1.0, 0.0, 0.0);
-		glColor3f(0.3, 0.4, 0.5);
-		glTranslatef(0, 0, 10.3);
-		glutSolidTorus(5.625, 14.35, 16, 40);
+		recordRotatef(90, 1.0, 0.0, 0.0);
+		recordTranslatef(0, 0, 10.3);
+		recordDraw(meshTorus, materialCircularPath, 1.0, 1.0, 1.0);
 	}
 	else if (currentPattern == straight && path) {
-		glTranslatef(0, -6.0, 0);
-		solidBoxColor(10.0, 0, 1000.0, 0.7, 0.6, 0.5);
+		recordTranslatef(0, -6.0, 0);
+		solidBoxMaterial(10.0, 0, 1000.0, materialStraightPath);
 	}
 
-	glPopMatrix();
+	recordPopMatrix();
 
 	// Draw one Robot with manipulated position
-	glPushMatrix();
-	glRotatef(robotRotationX, 1, 0, 0);
-	glRotatef(robotRotationY, 0, 1, 0);
-	glRotatef(robotRotationZ, 0, 0, 1);
-	glTranslatef(robotPositionX, robotPositionY, robotPositionZ);
+	recordPushMatrix();
+	recordRotatef(robotRotationX, 1, 0, 0);
+	recordRotatef(robotRotationY, 0, 1, 0);
+	recordRotatef(robotRotationZ, 0, 0, 1);
+	recordTranslatef(robotPositionX, robotPositionY, robotPositionZ);
 	drawScene();
-	glPopMatrix();
+	recordPopMatrix();
 
-	if (baxis) drawAxes(); // draw axes
+	if (baxis) recordDraw(meshAxes, materialVertexColor, 1.0, 1.0, 1.0); // draw axes
+	submitFrame();
 	glutSwapBuffers();
 	glFlush();
 }
@@ -327,10 +536,10 @@ void procKeys(unsigned char key, int x, int y)
 {
 	switch (key) {
 	case '1': // Wireframe Mode
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		wireframe = true;
 		break;
 	case '2': // Solid Mode
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		wireframe = false;
 		break;
 	case '3': baxis = !baxis; break; // Axis Switch
 	case '4': path = !path; break; // Toggles the path
@@ -341,6 +550,11 @@ void procKeys(unsigned char key, int x, int y)
 		else if (currentPattern == circular)    currentPattern = straight;
 		break;
 	case 'c': resetPosition(); music = !music; playSomeMusic(); currentPattern = polishCow; break;
+	case 's': // Prints the render counters of the last frame
+		printf("packets: %u, draws: %u, state changes: %u, dropped: %u, arena bytes: %u\n",
+			frameStats.packets, frameStats.draws, frameStats.stateChanges, frameStats.droppedPackets,
+			(unsigned int)frameStats.arenaBytes);
+		break;
 	case 27: exit(0); break; // Default Case
 	}
 	glutPostRedisplay();
@@ -564,12 +778,30 @@ void timer(int v) {
 	glutTimerFunc(1000 / 60, timer, v);
 }
 
+// Compiles the geometry of every renderMesh into a display list, so submitting
+// a packet is a single glCallList instead of GLUT rebuilding the mesh each frame
+void buildMeshLists() {
+	GLuint base = glGenLists(meshAxes + 1);
+	for (int mesh = meshCube; mesh <= meshAxes; mesh++) {
+		meshLists[mesh] = base + mesh;
+		glNewList(meshLists[mesh], GL_COMPILE);
+		switch (mesh) {
+		case meshCube: glutSolidCube(1.0); break;
+		case meshSphere: glutSolidSphere(1.0, 50.0, 50.0); break;
+		case meshTorus: glutSolidTorus(5.625, 14.35, 16, 40); break;
+		case meshAxes: drawAxes(); break;
+		}
+		glEndList();
+	}
+}
+
 // Initialize program, setting depth and other toggles for OpenGL
 void init() {
 	glShadeModel(GL_FLAT);
 	glMatrixMode(GL_MODELVIEW);
 	glEnable(GL_DEPTH_TEST);
 	glLoadIdentity();
+	buildMeshLists();
 }
 
 //////////////////////////////////////////////////////
@@ -635,6 +867,7 @@ int main(int argc, char** argv) {
  - 'r': move the robot to the initial position to be animated \n\
  - 'a': animation walking toggle ON/OFF (animation only) \n\
  - 'p': walking path options of the robot (circular or straight) \n\
+ - 's': print render counters (packets, draws, state changes, dropped) of the last frame \n\
  - Left Click + Drag: camera rotation \n\
  - Right Click + Drag: zoom in and out \n\
  - 'ESC': terminate the program \n\